@@ -10,12 +10,20 @@ CONFIG += c++11
 
 SOURCES += \
     animationframe.cpp \
+    inputreplay.cpp \
+    layerscaler.cpp \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    svgpathimporter.cpp \
+    trajectoryworker.cpp
 
 HEADERS += \
     animationframe.h \
-    mainwindow.h
+    inputreplay.h \
+    layerscaler.h \
+    mainwindow.h \
+    svgpathimporter.h \
+    trajectoryworker.h
 
 FORMS += \
     mainwindow.ui
@@ -1,4 +1,7 @@
 #include "animationframe.h"
+#include "layerscaler.h"
+#include "svgpathimporter.h"
+#include "trajectoryworker.h"
 
 #include <QDragEnterEvent>
 #include <QDropEvent>
@@ -10,10 +13,13 @@
 #include <QPaintEvent>
 #include <QPainter>
 #include <QPainterPath>
-#include <QPropertyAnimation>
 #include <QPushButton>
+#include <QResizeEvent>
 #include <QSizePolicy>
 #include <QTimeLine>
+#include <QTransform>
+
+#include <algorithm>
 
 namespace  {
 const int kPickedTolerance = 10;
@@ -22,18 +28,98 @@ const Qt::GlobalColor colors[4] = {
     Qt::darkGreen, Qt::magenta, Qt::darkCyan, Qt::darkYellow
 };
 const QSize kDefaultSize = QSize(600, 800);
+const int kAllObjects = (1 << AnimationFrame::kObjectCount) - 1;
+const int kPlaybackInterval = 1000 / 60;
 QEasingCurve::Type kObjecsEasingType[2] = {QEasingCurve::Linear, QEasingCurve::Linear};
 QString kMotionObjectImagePath[2] = {};
 }
+void AnimationFrame::SegmentTable::moveTo(const QPointF &p)
+{
+    lengths.push_back(lengths.isEmpty() ? 0 : lengths.last());
+    points.push_back(p);
+    outline.moveTo(p);
+}
+
+void AnimationFrame::SegmentTable::lineTo(const QPointF &p)
+{
+    if (points.isEmpty()) {
+        moveTo(p);
+        return;
+    }
+    lengths.push_back(lengths.last() + QLineF(points.last(), p).length());
+    points.push_back(p);
+    outline.lineTo(p);
+}
+
+bool AnimationFrame::SegmentTable::isEmpty() const
+{
+    return points.size() < 2;
+}
+
+qreal AnimationFrame::SegmentTable::length() const
+{
+    return lengths.isEmpty() ? 0 : lengths.last();
+}
+
+QPointF AnimationFrame::SegmentTable::pointAtPercent(qreal t) const
+{
+    if (points.isEmpty()) {
+        return QPointF();
+    }
+    qreal distance = qBound<qreal>(0, t, 1) * length();
+    auto it = std::upper_bound(lengths.begin(), lengths.end(), distance);
+    if (it == lengths.begin()) {
+        return points.first();
+    }
+    if (it == lengths.end()) {
+        return points.last();
+    }
+    int i = int(it - lengths.begin());
+    // lengths[i - 1] <= distance < lengths[i], so the segment is never empty
+    qreal ratio = (distance - lengths[i - 1]) / (lengths[i] - lengths[i - 1]);
+    return points[i - 1] + (points[i] - points[i - 1]) * ratio;
+}
+
 AnimationFrame::AnimationFrame(QWidget *parent)
     :QFrame(parent)
 {
     setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Preferred);
    _frameSize = kDefaultSize;
-   setMaximumSize(_frameSize);
-   setMinimumSize(_frameSize);
+   setFixedSize(_frameSize);
    setAcceptDrops(true);
 
+   _trajectoryWorker = new TrajectoryWorker;
+   _trajectoryWorker->moveToThread(&_trajectoryThread);
+   connect(&_trajectoryThread, &QThread::finished, _trajectoryWorker, &QObject::deleteLater);
+   connect(_trajectoryWorker, &TrajectoryWorker::computed, this, &AnimationFrame::onTrajectoryComputed);
+   _trajectoryThread.start();
+
+   _layerScaler = new LayerScaler;
+   _layerScaler->moveToThread(&_layerThread);
+   connect(&_layerThread, &QThread::finished, _layerScaler, &QObject::deleteLater);
+   connect(_layerScaler, &LayerScaler::scaled, this, &AnimationFrame::onBackgroundScaled);
+   _layerThread.start();
+
+   _svgImporter = new SvgPathImporter;
+   _svgImporter->moveToThread(&_svgThread);
+   connect(&_svgThread, &QThread::finished, _svgImporter, &QObject::deleteLater);
+   connect(_svgImporter, &SvgPathImporter::finished, this, &AnimationFrame::onSvgImported);
+   connect(_svgImporter, &SvgPathImporter::failed, this, [=](const QString& message, int generation) {
+       if (generation == _svgGeneration) {
+           qWarning() << message;
+       }
+   });
+   _svgThread.start();
+}
+
+AnimationFrame::~AnimationFrame()
+{
+    _trajectoryThread.quit();
+    _layerThread.quit();
+    _svgThread.quit();
+    _trajectoryThread.wait();
+    _layerThread.wait();
+    _svgThread.wait();
 }
 
 QSize AnimationFrame::sizeHint() const
@@ -43,7 +129,7 @@ QSize AnimationFrame::sizeHint() const
 
 QSize AnimationFrame::minimumSizeHint() const
 {
-    return QSize(600, 800);
+    return _frameSize;
 }
 
 QEasingCurve::Type AnimationFrame::getEasingTypeByIndex(int index)
@@ -51,106 +137,92 @@ QEasingCurve::Type AnimationFrame::getEasingTypeByIndex(int index)
     return kObjecsEasingType[index];
 }
 
-void AnimationFrame::playAnimation()
+AnimationFrame::PathType AnimationFrame::pathType() const
 {
-    if (_pathType == Line && _points.size() > 1) {
-        auto object = new QPushButton(this);
-        updateMotionObjectSurface(object, kMotionObjectImagePath[0]);
-        object->setFixedSize(QSize(40, 40));
-        object->setStyleSheet("");
-        object->show();
-        QPropertyAnimation *animation = new QPropertyAnimation(object, "pos");
-        animation->setDuration(_duration * 1000);
-        animation->setStartValue(_points[0]);
-        animation->setEndValue(_points[1]);
-        animation->setEasingCurve(kObjecsEasingType[0]);
-        animation->start();
-        connect(animation, &QPropertyAnimation::finished,[=]() {
-            object->deleteLater();
-        });
-        if (_comparisonMode) {
-            auto object = new QPushButton(this);
-            object->setStyleSheet("");
-            object->setFixedSize(QSize(40, 40));
-            QPropertyAnimation *animation = new QPropertyAnimation(object, "pos");
-            if (kMotionObjectImagePath[1].isEmpty()) {
-                object->setStyleSheet("background-color: qlineargradient(spread:pad, x1:0, y1:0, x2:1, y2:0, stop:0 rgba(0, 0, 0, 255), stop:1 rgba(255, 255, 255, 255));");
-            } else {
-                updateMotionObjectSurface(object, kMotionObjectImagePath[1]);
-            }
-            object->show();
-            animation->setDuration(_duration * 1000);
-            animation->setStartValue(_points[0]);
-            animation->setEndValue(_points[1]);
-            animation->setEasingCurve(kObjecsEasingType[1]);
-            animation->start();
-            connect(animation, &QPropertyAnimation::finished,[=]() {
-                object->deleteLater();
-            });
-        }
+    return _pathType;
+}
+
+const QVector<QPointF> &AnimationFrame::pathPoints() const
+{
+    return _points;
+}
+
+void AnimationFrame::setPathPoints(const QVector<QPointF> &points)
+{
+    _points = points;
+    requestTrajectory(kAllObjects);
+    update();
+}
 
+void AnimationFrame::importSvgPath(const QString &filePath)
+{
+    int generation = ++_svgGeneration;
+    auto importer = _svgImporter;
+    QMetaObject::invokeMethod(importer, [=]() {
+        importer->import(filePath, generation);
+    });
+}
 
-    } else if(_pathType == Bezier && _points.size() > 3) {
-        QTimeLine* timeLine = new QTimeLine(_duration * 1000, this);
+void AnimationFrame::playAnimation()
+{
+    // Start once the trajectory covering the latest edits is back
+    if (_trajectoryBusy || _dirtyObjects) {
+        _playPending = true;
+        return;
+    }
+    if (!_trajectory || _trajectory->frameCount == 0) {
+        return;
+    }
+    QVector<QPushButton*> objects;
+    for (int i = 0; i < (_comparisonMode ? kObjectCount : 1); i++) {
         auto object = new QPushButton(this);
         object->setFixedSize(QSize(40, 40));
         object->setStyleSheet("");
-        updateMotionObjectSurface(object, kMotionObjectImagePath[0]);
+        if (i == 1 && kMotionObjectImagePath[1].isEmpty()) {
+            object->setStyleSheet("background-color: qlineargradient(spread:pad, x1:0, y1:0, x2:1, y2:0, stop:0 rgba(0, 0, 0, 255), stop:1 rgba(255, 255, 255, 255));");
+        } else {
+            updateMotionObjectSurface(object, kMotionObjectImagePath[i]);
+        }
+        object->move(_trajectory->positionAt(i, 0));
         object->show();
-        timeLine->setEasingCurve(QEasingCurve(kObjecsEasingType[0]));
-        connect(timeLine, &QTimeLine::valueChanged, [=](qreal value) {
-            qDebug()<<"obj1 :" << value;
-            float currentTime = value;
-            QPoint p0 = _points[0];
-            QPoint p1 = _points[1];
-            QPoint p2 = _points[2];
-            QPoint p3 = _points[3];
-
-            QPoint position = p0 * pow(1 - currentTime, 3) +
-                    3 * p1 * currentTime * pow(1 - currentTime, 2) +
-                    3 * p2 * pow(currentTime, 2) * (1 - currentTime) +
-                    p3 * pow(currentTime, 3);
-            object->move(position);
-        });
-        connect(timeLine, &QTimeLine::finished, [=]() {
-            timeLine->deleteLater();
+        objects.push_back(object);
+    }
+    QTimeLine* timeLine = new QTimeLine(_duration * 1000, this);
+    timeLine->setUpdateInterval(kPlaybackInterval);
+    // Easing is already applied to the precomputed samples
+    timeLine->setEasingCurve(QEasingCurve::Linear);
+    auto finish = [=]() {
+        timeLine->deleteLater();
+        for (auto object : objects) {
             object->deleteLater();
-        });
-        timeLine->start();
-
-        if (_comparisonMode) {
-            auto object = new QPushButton(this);
-            object->setStyleSheet("");
-            object->setFixedSize(QSize(40, 40));
-            if (kMotionObjectImagePath[1].isEmpty()) {
-                object->setStyleSheet("background-color: qlineargradient(spread:pad, x1:0, y1:0, x2:1, y2:0, stop:0 rgba(0, 0, 0, 255), stop:1 rgba(255, 255, 255, 255));");
-            } else {
-                updateMotionObjectSurface(object, kMotionObjectImagePath[1]);
-            }
-            object->show();
-            QTimeLine* timeLine = new QTimeLine(_duration * 1000, this);
-            timeLine->setEasingCurve(QEasingCurve(kObjecsEasingType[1]));
-            connect(timeLine, &QTimeLine::valueChanged, [=](qreal value) {
-                qDebug()<<"obj2 :" << value;
-                float currentTime = value;
-                QPoint p0 = _points[0];
-                QPoint p1 = _points[1];
-                QPoint p2 = _points[2];
-                QPoint p3 = _points[3];
-
-                QPoint position = p0 * pow(1 - currentTime, 3) +
-                        3 * p1 * currentTime * pow(1 - currentTime, 2) +
-                        3 * p2 * pow(currentTime, 2) * (1 - currentTime) +
-                        p3 * pow(currentTime, 3);
-                object->move(position);
-            });
-            connect(timeLine, &QTimeLine::finished, [=]() {
-                timeLine->deleteLater();
-                object->deleteLater();
-            });
-            timeLine->start();
         }
-    }
+    };
+    connect(timeLine, &QTimeLine::valueChanged, [=](qreal value) {
+        // The path was reset or its type changed while playing, there is
+        // nothing left to follow. stop() does not emit finished.
+        if (_trajectory->frameCount == 0) {
+            timeLine->stop();
+            finish();
+            return;
+        }
+        // Read the front buffer on every tick so edits made while playing show up
+        for (int i = 0; i < objects.size(); i++) {
+            objects[i]->move(_trajectory->positionAt(i, value));
+        }
+    });
+    connect(timeLine, &QTimeLine::finished, finish);
+    timeLine->start();
+}
+
+void AnimationFrame::onBackgroundImageChanged(const QString &imagePath)
+{
+    _backgroundImage = imagePath;
+    // Always decode again, even for the same path
+    _backgroundSource++;
+    _background = QImage();
+    _requestedBackgroundSize = QSize();
+    requestBackground();
+    update();
 }
 
 void AnimationFrame::onComparisonModeChanged(bool comparsionMode)
@@ -161,11 +233,13 @@ void AnimationFrame::onComparisonModeChanged(bool comparsionMode)
 void AnimationFrame::onDurationChanged(double duration)
 {
     _duration = duration;
+    requestTrajectory(kAllObjects);
 }
 
 void AnimationFrame::onEasingChanged(QEasingCurve::Type type)
 {
     kObjecsEasingType[_selectedObjectIndex] = type;
+    requestTrajectory(1 << _selectedObjectIndex);
 }
 
 void AnimationFrame::onMotionObjectSelected(int index)
@@ -187,23 +261,31 @@ void AnimationFrame::onPathTypeChanged(PathType pathType)
 {
     _pathType = pathType;
     _points.clear();
+    requestTrajectory(kAllObjects);
     update();
 }
 
 void AnimationFrame::onResetPath()
 {
     _points.clear();
+    // Drop an import that is still in flight as well
+    _svgGeneration++;
+    _svg = SegmentTable();
+    _svgOutline = QPainterPath();
+    requestTrajectory(kAllObjects);
     update();
 }
 
 void AnimationFrame::onWidthChanged(int w)
 {
     _frameSize.setWidth(w);
+    setFixedSize(_frameSize);
 }
 
 void AnimationFrame::onHeightChanged(int h)
 {
     _frameSize.setHeight(h);
+    setFixedSize(_frameSize);
 }
 
 void AnimationFrame::dragEnterEvent(QDragEnterEvent *event)
@@ -230,13 +312,15 @@ void AnimationFrame::dropEvent(QDropEvent *event)
     auto mimeData = event->mimeData();
     if (mimeData->hasUrls()) {
         QUrl file = mimeData->urls()[0];
-        _backgroundImage = file.toLocalFile();
-        update();
+        onBackgroundImageChanged(file.toLocalFile());
     }
 }
 
 void AnimationFrame::mousePressEvent(QMouseEvent *event)
 {
+    if (_pathType == Svg) {
+        return;
+    }
     if(_pathType == Line) {
         if (_points.size() == 2) {
             _pickedPointIndex = pickedPointIndex(event->pos());
@@ -249,14 +333,16 @@ void AnimationFrame::mousePressEvent(QMouseEvent *event)
             return;
         }
     }
-    _points.push_back(event->pos());
+    _points.push_back(fromFrame(event->pos()));
+    requestTrajectory(kAllObjects);
 }
 
 void AnimationFrame::mouseMoveEvent(QMouseEvent *event) {
     QRect moveRegion = this->rect();
     moveRegion.adjust(10, 10, -10, -10);
     if (_pickedPointIndex != -1 && moveRegion.contains(event->pos())) {
-        _points[_pickedPointIndex] = event->pos();
+        _points[_pickedPointIndex] = fromFrame(event->pos());
+        requestTrajectory(kAllObjects);
         update();
     }
     qDebug() << event;
@@ -274,60 +360,87 @@ void AnimationFrame::paintEvent(QPaintEvent *event)
 {
     QPainter painter(this);
     painter.setRenderHint(QPainter::Antialiasing);
-    QImage image;
-    if (_backgroundImage.isEmpty()) {
-        image = QImage(this->size(), QImage::Format_ARGB32);
-        image.fill(Qt::white);
-    } else {
-        image.load(_backgroundImage);
-        image = image.scaled(this->size(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    // A device pixel ratio change is only noticed here, the rescale itself
+    // still runs on the layer thread.
+    if (!_backgroundImage.isEmpty() && _requestedBackgroundSize != size() * devicePixelRatioF()) {
+        requestBackground();
     }
     QPen pen;
     pen.setCapStyle(Qt::SquareCap);
     pen.setColor(QColor(0xd722a7));
     pen.setWidth(3);
     painter.setPen(pen);
-    painter.drawImage(QPoint(0, 0), image);
+    if (_background.isNull()) {
+        painter.fillRect(rect(), Qt::white);
+    } else {
+        // Until the rescaled layer arrives the previous one is stretched
+        painter.drawImage(rect(), _background);
+    }
+    if (_pathType == Svg && !_svg.isEmpty()) {
+        painter.drawPath(_svgOutline);
+        QPen pen = painter.pen();
+        QTransform transform = svgTransform();
+        pen.setColor(colors[0]);
+        painter.setPen(pen);
+        painter.drawEllipse(transform.map(_svg.points.first()), kCircleRadius, kCircleRadius);
+        pen.setColor(colors[3]);
+        painter.setPen(pen);
+        painter.drawEllipse(transform.map(_svg.points.last()), kCircleRadius, kCircleRadius);
+        return;
+    }
     painter.save();
     if( _points.size() < 1) {
         return;
     }
-    if (_pathType == Line && _points.size() == 2) {
+    QVector<QPointF> points;
+    for (auto point : _points) {
+        points.push_back(toFrame(point));
+    }
+    if (_pathType == Line && points.size() == 2) {
         QPen pen = painter.pen();
         pen.setColor(colors[0]);
         painter.setPen(pen);
-        painter.drawEllipse(_points[0], kCircleRadius, kCircleRadius);
+        painter.drawEllipse(points[0], kCircleRadius, kCircleRadius);
 
         painter.restore();
-        painter.drawLine(_points[0],_points[1]);
+        painter.drawLine(points[0],points[1]);
 
         pen.setColor(colors[3]);
         painter.setPen(pen);
-        painter.drawEllipse(_points[1], kCircleRadius, kCircleRadius);
+        painter.drawEllipse(points[1], kCircleRadius, kCircleRadius);
 
-    } else if (_pathType == Bezier && _points.size() == 4) {
+    } else if (_pathType == Bezier && points.size() == 4) {
         QPainterPath path;
-        path.moveTo(_points[0]);
-        path.cubicTo(_points[1], _points[2], _points[3]);
+        path.moveTo(points[0]);
+        path.cubicTo(points[1], points[2], points[3]);
         int i = 4;
         QPen pen = painter.pen();
         while (i--) {
             pen.setColor(colors[i]);
             painter.setPen(pen);
-            painter.drawEllipse(_points[i], kCircleRadius, kCircleRadius);
+            painter.drawEllipse(points[i], kCircleRadius, kCircleRadius);
         }
         painter.restore();
         painter.drawPath(path);
     } else {
         QPen pen = painter.pen();
-        for(int i = 0; i < _points.size(); i++){
+        for(int i = 0; i < points.size(); i++){
             pen.setColor(colors[i]);
             painter.setPen(pen);
-            painter.drawEllipse(_points[i], kCircleRadius, kCircleRadius);
+            painter.drawEllipse(points[i], kCircleRadius, kCircleRadius);
         }
     }
 }
 
+void AnimationFrame::resizeEvent(QResizeEvent *event)
+{
+    QFrame::resizeEvent(event);
+    // Path points are normalized, only the cached pixel geometry follows
+    _svgOutline = svgTransform().map(_svg.outline);
+    requestTrajectory(kAllObjects);
+    requestBackground();
+}
+
 void AnimationFrame::showEvent(QShowEvent *event)
 {
     QFrame::showEvent(event);
@@ -336,21 +449,22 @@ void AnimationFrame::showEvent(QShowEvent *event)
 
 void AnimationFrame::initialPath()
 {
-    _points.push_back(QPoint(50,50));
+    _points.push_back(fromFrame(QPoint(50,50)));
     auto size = this->size();
     auto p2 = QPoint(size.width() - 50, size.height() - 50);
-    _points.push_back(p2);
+    _points.push_back(fromFrame(p2));
+    requestTrajectory(kAllObjects);
     update();
 }
 
 int AnimationFrame::pickedPointIndex(const QPoint &mousePoint)
 {
-    auto distance = [](QPoint p1, QPoint p2) {
-        return  sqrt(pow(p1.x() - p2.x(), 2) + pow(p1.x() - p2.x(), 2));
+    auto distance = [](QPointF p1, QPointF p2) {
+        return  sqrt(pow(p1.x() - p2.x(), 2) + pow(p1.y() - p2.y(), 2));
     };
     int i = 0;
     for (auto point : _points) {
-        if (distance(point, mousePoint) <= kPickedTolerance) {
+        if (distance(toFrame(point), mousePoint) <= kPickedTolerance) {
             return i;
         }
         i++;
@@ -358,6 +472,123 @@ int AnimationFrame::pickedPointIndex(const QPoint &mousePoint)
     return -1;
 }
 
+QPointF AnimationFrame::toFrame(const QPointF &point) const
+{
+    return QPointF(point.x() * width(), point.y() * height());
+}
+
+QPointF AnimationFrame::fromFrame(const QPointF &point) const
+{
+    return QPointF(point.x() / width(), point.y() / height());
+}
+
+QTransform AnimationFrame::svgTransform() const
+{
+    // Fit the viewBox into the frame keeping its aspect ratio, like the
+    // default preserveAspectRatio="xMidYMid meet".
+    QTransform transform;
+    if (_svg.viewBox.isEmpty()) {
+        return transform;
+    }
+    qreal scale = qMin(width() / _svg.viewBox.width(), height() / _svg.viewBox.height());
+    transform.translate((width() - _svg.viewBox.width() * scale) / 2,
+                        (height() - _svg.viewBox.height() * scale) / 2);
+    transform.scale(scale, scale);
+    transform.translate(-_svg.viewBox.x(), -_svg.viewBox.y());
+    return transform;
+}
+
+void AnimationFrame::requestTrajectory(int dirtyObjects)
+{
+    _dirtyObjects |= dirtyObjects;
+    // Edits made while the worker is busy are coalesced into the next request
+    if (_trajectoryBusy) {
+        return;
+    }
+    TrajectoryRequest request;
+    request.pathType = _pathType;
+    for (auto point : _points) {
+        request.points.push_back(toFrame(point).toPoint());
+    }
+    request.svg = _svg;
+    request.svgTransform = svgTransform();
+    for (int i = 0; i < kObjectCount; i++) {
+        request.easingTypes[i] = kObjecsEasingType[i];
+    }
+    request.duration = _duration;
+    request.dirtyObjects = _dirtyObjects;
+    _dirtyObjects = 0;
+    _trajectoryBusy = true;
+    auto worker = _trajectoryWorker;
+    QMetaObject::invokeMethod(worker, [worker, request]() {
+        worker->compute(request);
+    });
+}
+
+void AnimationFrame::onTrajectoryComputed(const QSharedPointer<const TrajectoryBuffer> &buffer)
+{
+    _trajectory = buffer;
+    _trajectoryBusy = false;
+    if (_dirtyObjects) {
+        requestTrajectory(0);
+    } else if (_playPending) {
+        _playPending = false;
+        playAnimation();
+    }
+}
+
+bool AnimationFrame::isBackgroundPending() const
+{
+    return _backgroundPending;
+}
+
+bool AnimationFrame::isBackgroundFailed() const
+{
+    return !_backgroundImage.isEmpty() && !_backgroundPending && _background.isNull();
+}
+
+void AnimationFrame::requestBackground()
+{
+    if (_backgroundImage.isEmpty()) {
+        return;
+    }
+    _backgroundPending = true;
+    qreal devicePixelRatio = devicePixelRatioF();
+    _requestedBackgroundSize = size() * devicePixelRatio;
+    int generation = ++_backgroundGeneration;
+    auto scaler = _layerScaler;
+    QString imagePath = _backgroundImage;
+    int source = _backgroundSource;
+    QSize size = this->size();
+    scaler->setLatestGeneration(generation);
+    QMetaObject::invokeMethod(scaler, [=]() {
+        scaler->scale(imagePath, source, size, devicePixelRatio, generation);
+    });
+}
+
+void AnimationFrame::onBackgroundScaled(const QImage &image, int generation)
+{
+    if (generation != _backgroundGeneration) {
+        return;
+    }
+    _backgroundPending = false;
+    _background = image;
+    update();
+    emit backgroundReady(!image.isNull());
+}
+
+void AnimationFrame::onSvgImported(const SegmentTable &table, int generation)
+{
+    if (generation != _svgGeneration) {
+        return;
+    }
+    _svg = table;
+    _svgOutline = svgTransform().map(_svg.outline);
+    requestTrajectory(kAllObjects);
+    update();
+    emit svgPathImported();
+}
+
 void AnimationFrame::updateMotionObjectSurface(QPushButton *btn, const QString &imagePath)
 {
     if (imagePath.isEmpty()) {
@@ -365,8 +596,12 @@ void AnimationFrame::updateMotionObjectSurface(QPushButton *btn, const QString &
     }
     QPixmap pic(imagePath);
     btn->setFixedSize(QSize(40, 40));
+    // Widget masks are in logical pixels, the icon gets the device pixels
+    qreal devicePixelRatio = btn->devicePixelRatioF();
+    QPixmap icon = pic.scaled(btn->size() * devicePixelRatio, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+    icon.setDevicePixelRatio(devicePixelRatio);
     pic = pic.scaled(btn->size(), Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
     btn->setMask(pic.mask());
-    btn->setIcon(QIcon(imagePath));
+    btn->setIcon(QIcon(icon));
     btn->setIconSize(btn->size());
 }
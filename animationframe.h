@@ -3,18 +3,30 @@
 
 #include <QEasingCurve>
 #include <QFrame>
+#include <QImage>
+#include <QPainterPath>
+#include <QRectF>
+#include <QSharedPointer>
 #include <QString>
+#include <QThread>
 #include <QVector2D>
+#include <QVector>
 
+class LayerScaler;
 class QPushButton;
+class SvgPathImporter;
+class TrajectoryWorker;
+struct TrajectoryBuffer;
 
 class AnimationFrame : public QFrame
 {
     Q_OBJECT
 public:
+    static const int kObjectCount = 2;
     enum PathType {
         Line,
-        Bezier
+        Bezier,
+        Svg
     };
     struct Line {
         QPoint st;
@@ -26,6 +38,19 @@ public:
         QPoint c2;
         QPoint end;
     };
+    // Imported path flattened once into a polyline, lengths[i] is the arc
+    // length from points[0] to points[i] so playback is a binary search.
+    struct SegmentTable {
+        QVector<QPointF>    points;
+        QVector<qreal>      lengths;
+        QPainterPath        outline;
+        QRectF              viewBox;
+        void moveTo(const QPointF& p);
+        void lineTo(const QPointF& p);
+        bool isEmpty() const;
+        qreal length() const;
+        QPointF pointAtPercent(qreal t) const;
+    };
 
     struct Path {
         PathType type;
@@ -36,11 +61,19 @@ public:
     };
 public:
     AnimationFrame(QWidget* parent);
+    ~AnimationFrame();
     QSize sizeHint() const;
     QSize minimumSizeHint() const;
     QEasingCurve::Type getEasingTypeByIndex(int index);
+    PathType pathType() const;
+    const QVector<QPointF>& pathPoints() const;
+    void setPathPoints(const QVector<QPointF>& points);
+    void importSvgPath(const QString& filePath);
+    bool isBackgroundPending() const;
+    bool isBackgroundFailed() const;
 public slots:
     void playAnimation();
+    void onBackgroundImageChanged(const QString& imagePath);
     void onComparisonModeChanged(bool comparsionMode);
     void onDurationChanged(double duration);
     void onEasingChanged(QEasingCurve::Type type);
@@ -51,6 +84,11 @@ public slots:
     void onResetPath();
     void onWidthChanged(int w);
     void onHeightChanged(int h);
+signals:
+    void svgPathImported();
+    // The latest background request has been scaled, ok is false if the
+    // image could not be loaded
+    void backgroundReady(bool ok);
 protected:
     virtual void dragEnterEvent(QDragEnterEvent *event);
     virtual void dropEvent(QDropEvent *event);
@@ -58,10 +96,19 @@ protected:
     virtual void mouseMoveEvent(QMouseEvent *event);
     virtual void mouseReleaseEvent(QMouseEvent *event);
     virtual void paintEvent(QPaintEvent *event);
+    virtual void resizeEvent(QResizeEvent *event);
     virtual void showEvent(QShowEvent *event);
 private:
     void initialPath();
     int pickedPointIndex(const QPoint& mousePoint);
+    QPointF toFrame(const QPointF& point) const;
+    QPointF fromFrame(const QPointF& point) const;
+    void requestBackground();
+    void onBackgroundScaled(const QImage& image, int generation);
+    QTransform svgTransform() const;
+    void requestTrajectory(int dirtyObjects);
+    void onTrajectoryComputed(const QSharedPointer<const TrajectoryBuffer>& buffer);
+    void onSvgImported(const SegmentTable& table, int generation);
     void updateMotionObjectSurface(QPushButton* btn, const QString& imagePath);
 private:
     bool                _comparisonMode = false;
@@ -75,7 +122,26 @@ private:
     QSize               _frameSize;
     int                 _pickedPointIndex = -1;
     int                 _selectedObjectIndex = 0;
-    QVector<QPoint>     _points;
+    // Control points normalized to the frame, so they follow resizes
+    QVector<QPointF>    _points;
+    SegmentTable        _svg;
+    QPainterPath        _svgOutline;
+    QThread             _svgThread;
+    SvgPathImporter*    _svgImporter;
+    int                 _svgGeneration = 0;
+    QThread             _trajectoryThread;
+    TrajectoryWorker*   _trajectoryWorker;
+    QSharedPointer<const TrajectoryBuffer> _trajectory;
+    int                 _dirtyObjects = 0;
+    bool                _trajectoryBusy = false;
+    bool                _playPending = false;
+    QThread             _layerThread;
+    LayerScaler*        _layerScaler;
+    QImage              _background;
+    QSize               _requestedBackgroundSize;
+    int                 _backgroundGeneration = 0;
+    int                 _backgroundSource = 0;
+    bool                _backgroundPending = false;
 };
 
 #endif // ANIMATIONFRAME_H
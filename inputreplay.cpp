@@ -0,0 +1,269 @@
+#include "inputreplay.h"
+
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QMouseEvent>
+#include <QTimer>
+
+#include <algorithm>
+#include <cmath>
+
+namespace  {
+const char kFileMagic[] = "AnimationPreviewInput";
+const int kFileVersion = 3;
+
+double percentile(const QVector<qint64>& sorted, double p)
+{
+    if (sorted.isEmpty()) {
+        return 0.0;
+    }
+    // Nearest-rank percentile, reported in milliseconds.
+    int rank = int(std::ceil(p / 100.0 * sorted.size()));
+    int index = qBound(0, rank - 1, int(sorted.size()) - 1);
+    return sorted[index] / 1000000.0;
+}
+}
+
+InputRecorder::InputRecorder(AnimationFrame *frame, const QString &filePath, QObject *parent)
+    :QObject(parent)
+    ,_frame(frame)
+    ,_file(filePath)
+{
+}
+
+InputRecorder::~InputRecorder()
+{
+    if (_file.isOpen()) {
+        _stream.flush();
+        _file.close();
+    }
+}
+
+bool InputRecorder::start()
+{
+    if (!_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        return false;
+    }
+    _stream.setDevice(&_file);
+    _stream << kFileMagic << ' ' << kFileVersion << '\n';
+    _frame->installEventFilter(this);
+    return true;
+}
+
+bool InputRecorder::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == _frame &&
+        (event->type() == QEvent::MouseButtonPress ||
+         event->type() == QEvent::MouseMove ||
+         event->type() == QEvent::MouseButtonRelease)) {
+        if (!_stateWritten) {
+            writeState();
+            _clock.start();
+        }
+        auto mouseEvent = static_cast<QMouseEvent*>(event);
+        _stream << "event "
+                << _clock.elapsed() << ' '
+                << int(event->type()) << ' '
+                << mouseEvent->position().x() << ' '
+                << mouseEvent->position().y() << ' '
+                << int(mouseEvent->button()) << ' '
+                << int(mouseEvent->buttons()) << ' '
+                << int(mouseEvent->modifiers()) << '\n';
+        if (event->type() == QEvent::MouseButtonRelease) {
+            _stream.flush();
+        }
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void InputRecorder::writeState()
+{
+    const QVector<QPointF>& points = _frame->pathPoints();
+    _stream << "state " << int(_frame->pathType()) << ' '
+            << _frame->width() << ' ' << _frame->height() << ' '
+            << points.size();
+    for (auto point : points) {
+        _stream << ' ' << point.x() << ' ' << point.y();
+    }
+    _stream << '\n';
+    _stateWritten = true;
+}
+
+QString InputReplayer::Report::toString() const
+{
+    return QString("events: %1 painted: %2 p50: %3 ms p95: %4 ms p99: %5 ms max: %6 ms")
+            .arg(events)
+            .arg(painted)
+            .arg(p50, 0, 'f', 3)
+            .arg(p95, 0, 'f', 3)
+            .arg(p99, 0, 'f', 3)
+            .arg(max, 0, 'f', 3);
+}
+
+InputReplayer::InputReplayer(AnimationFrame *frame, QObject *parent)
+    :QObject(parent)
+    ,_frame(frame)
+{
+    _frame->installEventFilter(this);
+}
+
+bool InputReplayer::load(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        _errorString = file.errorString();
+        return false;
+    }
+    QTextStream stream(&file);
+    QStringList header = stream.readLine().split(' ', Qt::SkipEmptyParts);
+    if (header.size() != 2 || header[0] != kFileMagic || header[1].toInt() != kFileVersion) {
+        _errorString = QString("%1 is not a recorded input session").arg(filePath);
+        return false;
+    }
+    _points.clear();
+    _events.clear();
+    int lineNumber = 1;
+    while (!stream.atEnd()) {
+        lineNumber++;
+        QStringList fields = stream.readLine().split(' ', Qt::SkipEmptyParts);
+        if (fields.isEmpty()) {
+            continue;
+        }
+        if (fields[0] == "state" && fields.size() >= 5) {
+            int pathType = fields[1].toInt();
+            if (pathType < AnimationFrame::Line || pathType > AnimationFrame::Svg) {
+                _errorString = QString("Unknown path type %1 at line %2").arg(fields[1]).arg(lineNumber);
+                return false;
+            }
+            _pathType = AnimationFrame::PathType(pathType);
+            _frameSize = QSize(fields[2].toInt(), fields[3].toInt());
+            int count = fields[4].toInt();
+            if (_frameSize.isEmpty() || fields.size() != 5 + count * 2) {
+                _errorString = QString("Malformed state at line %1").arg(lineNumber);
+                return false;
+            }
+            for (int i = 0; i < count; i++) {
+                _points.push_back(QPointF(fields[5 + i * 2].toDouble(), fields[6 + i * 2].toDouble()));
+            }
+        } else if (fields[0] == "event" && fields.size() == 8) {
+            Event event;
+            event.time = fields[1].toLongLong();
+            event.type = QEvent::Type(fields[2].toInt());
+            // Anything else would reach the frame as a mistyped QMouseEvent
+            if (event.type != QEvent::MouseButtonPress &&
+                event.type != QEvent::MouseMove &&
+                event.type != QEvent::MouseButtonRelease) {
+                _errorString = QString("Unsupported event type %1 at line %2").arg(fields[2]).arg(lineNumber);
+                return false;
+            }
+            event.pos = QPointF(fields[3].toDouble(), fields[4].toDouble());
+            event.button = Qt::MouseButton(fields[5].toInt());
+            event.buttons = Qt::MouseButtons(fields[6].toInt());
+            event.modifiers = Qt::KeyboardModifiers(fields[7].toInt());
+            _events.push_back(event);
+        } else {
+            _errorString = QString("Unknown record at line %1").arg(lineNumber);
+            return false;
+        }
+    }
+    return true;
+}
+
+QString InputReplayer::errorString() const
+{
+    return _errorString;
+}
+
+void InputReplayer::setSpeed(double speed)
+{
+    _speed = speed;
+}
+
+bool InputReplayer::run(Report *report)
+{
+    // Let the frame settle (show, initial path, first paint) before replaying.
+    QCoreApplication::processEvents();
+    applyState();
+    QCoreApplication::processEvents();
+    if (!waitForBackground()) {
+        return false;
+    }
+
+    QVector<qint64> latencies;
+    latencies.reserve(_events.size());
+    QElapsedTimer clock;
+    clock.start();
+    for (const auto& recorded : _events) {
+        if (_speed > 0) {
+            waitUntil(clock, qint64(recorded.time / _speed));
+        }
+        QMouseEvent event(recorded.type, recorded.pos, recorded.button, recorded.buttons, recorded.modifiers);
+        _painted = false;
+        QElapsedTimer latency;
+        latency.start();
+        QCoreApplication::sendEvent(_frame, &event);
+        // update() only posts an UpdateRequest, a single pass delivers it and paints.
+        QCoreApplication::processEvents();
+        if (_painted) {
+            latencies.push_back(latency.nsecsElapsed());
+        }
+    }
+
+    report->events = int(_events.size());
+    report->painted = int(latencies.size());
+    std::sort(latencies.begin(), latencies.end());
+    report->p50 = percentile(latencies, 50);
+    report->p95 = percentile(latencies, 95);
+    report->p99 = percentile(latencies, 99);
+    report->max = percentile(latencies, 100);
+    return true;
+}
+
+bool InputReplayer::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == _frame && event->type() == QEvent::Paint) {
+        _painted = true;
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void InputReplayer::applyState()
+{
+    // Event positions are in pixels, so replay into a frame of the recorded size
+    if (!_frameSize.isEmpty()) {
+        _frame->onWidthChanged(_frameSize.width());
+        _frame->onHeightChanged(_frameSize.height());
+    }
+    _frame->onPathTypeChanged(_pathType);
+    _frame->setPathPoints(_points);
+}
+
+bool InputReplayer::waitForBackground()
+{
+    if (_frame->isBackgroundPending()) {
+        QEventLoop loop;
+        connect(_frame, &AnimationFrame::backgroundReady, &loop, &QEventLoop::quit);
+        // Stale results are dropped without a signal, wait for the latest one
+        while (_frame->isBackgroundPending()) {
+            loop.exec();
+        }
+    }
+    if (_frame->isBackgroundFailed()) {
+        _errorString = "Cannot load the background image";
+        return false;
+    }
+    // Deliver the repaint with the scaled background before timing starts
+    QCoreApplication::processEvents();
+    return true;
+}
+
+void InputReplayer::waitUntil(const QElapsedTimer &clock, qint64 due)
+{
+    qint64 remaining = due - clock.elapsed();
+    if (remaining <= 0) {
+        return;
+    }
+    QEventLoop loop;
+    QTimer::singleShot(int(remaining), Qt::PreciseTimer, &loop, &QEventLoop::quit);
+    loop.exec();
+}
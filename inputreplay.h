@@ -0,0 +1,87 @@
+#ifndef INPUTREPLAY_H
+#define INPUTREPLAY_H
+
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QFile>
+#include <QObject>
+#include <QPointF>
+#include <QSize>
+#include <QString>
+#include <QTextStream>
+#include <QVector>
+
+#include "animationframe.h"
+
+// Records the mouse interaction on an AnimationFrame into a plain text file.
+// The frame size and path state are written once, right before the first
+// recorded event, so the replay starts from the same control points the user
+// started dragging.
+class InputRecorder : public QObject
+{
+    Q_OBJECT
+public:
+    InputRecorder(AnimationFrame* frame, const QString& filePath, QObject* parent = nullptr);
+    ~InputRecorder();
+    bool start();
+protected:
+    bool eventFilter(QObject *watched, QEvent *event);
+private:
+    void writeState();
+private:
+    AnimationFrame*     _frame;
+    QFile               _file;
+    QTextStream         _stream;
+    QElapsedTimer       _clock;
+    bool                _stateWritten = false;
+};
+
+// Replays a recorded session into an AnimationFrame and measures the time
+// from delivering each mouse event until the repaint it caused has finished.
+// Timing starts only once the background layer is ready, otherwise the first
+// events would measure the image decode instead of the interaction.
+class InputReplayer : public QObject
+{
+    Q_OBJECT
+public:
+    struct Event {
+        qint64              time;
+        QEvent::Type        type;
+        QPointF             pos;
+        Qt::MouseButton     button;
+        Qt::MouseButtons    buttons;
+        Qt::KeyboardModifiers modifiers;
+    };
+    struct Report {
+        int     events = 0;
+        int     painted = 0;
+        double  p50 = 0.0;
+        double  p95 = 0.0;
+        double  p99 = 0.0;
+        double  max = 0.0;
+        QString toString() const;
+    };
+public:
+    InputReplayer(AnimationFrame* frame, QObject* parent = nullptr);
+    bool load(const QString& filePath);
+    QString errorString() const;
+    void setSpeed(double speed);
+    bool run(Report* report);
+protected:
+    bool eventFilter(QObject *watched, QEvent *event);
+private:
+    void applyState();
+    bool waitForBackground();
+    void waitUntil(const QElapsedTimer& clock, qint64 due);
+private:
+    AnimationFrame*                 _frame;
+    AnimationFrame::PathType        _pathType = AnimationFrame::Line;
+    QVector<QPointF>                _points;
+    QSize                           _frameSize;
+    QVector<Event>                  _events;
+    QString                         _errorString;
+    double                          _speed = 1.0;
+    bool                            _painted = false;
+};
+
+#endif // INPUTREPLAY_H
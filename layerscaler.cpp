@@ -0,0 +1,33 @@
+#include "layerscaler.h"
+
+LayerScaler::LayerScaler(QObject *parent)
+    :QObject(parent)
+{
+}
+
+void LayerScaler::setLatestGeneration(int generation)
+{
+    _latestGeneration.storeRelease(generation);
+}
+
+void LayerScaler::scale(const QString &imagePath, int sourceGeneration, const QSize &size, qreal devicePixelRatio, int generation)
+{
+    if (generation != _latestGeneration.loadAcquire()) {
+        return;
+    }
+    // Decode once per source, resizes only rescale the cached image
+    if (sourceGeneration != _sourceGeneration) {
+        _sourceGeneration = sourceGeneration;
+        _source.load(imagePath);
+        if (!_source.isNull()) {
+            _source = _source.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        }
+    }
+    if (_source.isNull()) {
+        emit scaled(QImage(), generation);
+        return;
+    }
+    QImage image = _source.scaled(size * devicePixelRatio, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    image.setDevicePixelRatio(devicePixelRatio);
+    emit scaled(image, generation);
+}
@@ -0,0 +1,30 @@
+#ifndef LAYERSCALER_H
+#define LAYERSCALER_H
+
+#include <QAtomicInt>
+#include <QImage>
+#include <QObject>
+#include <QSize>
+#include <QString>
+
+// Decodes and rescales the background off the GUI thread. Only the latest
+// request is worth doing, so older generations are dropped before any work,
+// which keeps a quick sweep through sizes from queueing up stale rescales.
+// The image is decoded again whenever the source generation changes, so a
+// file replaced on disk or a failed load is picked up by setting it again.
+class LayerScaler : public QObject
+{
+    Q_OBJECT
+public:
+    LayerScaler(QObject* parent = nullptr);
+    void setLatestGeneration(int generation);
+    void scale(const QString& imagePath, int sourceGeneration, const QSize& size, qreal devicePixelRatio, int generation);
+signals:
+    void scaled(const QImage& image, int generation);
+private:
+    QAtomicInt  _latestGeneration;
+    int         _sourceGeneration = 0;
+    QImage      _source;
+};
+
+#endif // LAYERSCALER_H
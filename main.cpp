@@ -1,12 +1,62 @@
 #include "mainwindow.h"
+#include "animationframe.h"
+#include "inputreplay.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
 #include <QDir>
 #include <QLocale>
+#include <QTextStream>
 #include <QTranslator>
 int main(int argc, char *argv[])
 {
+    //Replay runs headless unless a platform is explicitly requested
+    for (int i = 1; i < argc; i++) {
+        bool replay = qstrcmp(argv[i], "--replay") == 0 || qstrncmp(argv[i], "--replay=", 9) == 0;
+        if (replay && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+        }
+    }
     QApplication a(argc, argv);
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption recordOption("record", "Record mouse input on the viewport to <file>.", "file");
+    QCommandLineOption replayOption("replay", "Replay recorded input from <file> and report paint latency.", "file");
+    QCommandLineOption speedOption("speed", "Replay rate multiplier, 0 replays as fast as possible.", "factor", "1");
+    QCommandLineOption backgroundOption("background", "Background image used during replay.", "file");
+    parser.addOption(recordOption);
+    parser.addOption(replayOption);
+    parser.addOption(speedOption);
+    parser.addOption(backgroundOption);
+    parser.process(a);
+
+    if (parser.isSet(replayOption)) {
+        AnimationFrame frame(nullptr);
+        if (parser.isSet(backgroundOption)) {
+            frame.onBackgroundImageChanged(parser.value(backgroundOption));
+        }
+        frame.show();
+        InputReplayer replayer(&frame);
+        if (!replayer.load(parser.value(replayOption))) {
+            QTextStream(stderr) << replayer.errorString() << Qt::endl;
+            return 1;
+        }
+        bool ok = false;
+        double speed = parser.value(speedOption).toDouble(&ok);
+        if (!ok || speed < 0) {
+            QTextStream(stderr) << "Invalid speed " << parser.value(speedOption) << Qt::endl;
+            return 1;
+        }
+        replayer.setSpeed(speed);
+        InputReplayer::Report report;
+        if (!replayer.run(&report)) {
+            QTextStream(stderr) << replayer.errorString() << Qt::endl;
+            return 1;
+        }
+        QTextStream(stdout) << report.toString() << Qt::endl;
+        return 0;
+    }
+
     //Get current system language
     auto systemLocale = QLocale::system();
     auto localLanguage = systemLocale.language();
@@ -20,5 +70,12 @@ int main(int argc, char *argv[])
     }
     MainWindow w;
     w.show();
+    if (parser.isSet(recordOption)) {
+        auto recorder = new InputRecorder(w.findChild<AnimationFrame*>(), parser.value(recordOption), &w);
+        if (!recorder->start()) {
+            QTextStream(stderr) << "Cannot record to " << parser.value(recordOption) << Qt::endl;
+            return 1;
+        }
+    }
     return a.exec();
 }
@@ -17,10 +17,15 @@ MainWindow::MainWindow(QWidget *parent)
     ui->easingCurvePicker->setMinimumHeight(_iconSize.height() + 50);
     ui->comboBox_pathType->addItem(tr("Line"));
     ui->comboBox_pathType->addItem(tr("Bezier"));
+    ui->comboBox_pathType->addItem(tr("Svg"));
     createCurveIcons();
     ui->easingCurvePicker->setCurrentRow(0);
     ui->pushButton_3->setFixedSize(QSize(40, 40));
     ui->pushButton_4->setFixedSize(QSize(40, 40));
+    // Only leave the current path once the import has succeeded
+    connect(ui->frame, &AnimationFrame::svgPathImported, this, [=]() {
+        ui->comboBox_pathType->setCurrentIndex(AnimationFrame::Svg);
+    });
 }
 
 MainWindow::~MainWindow()
@@ -197,3 +202,12 @@ void MainWindow::on_pushButton_4_clicked()
     }
 }
 
+
+
+void MainWindow::on_pushButton_5_clicked()
+{
+    auto svgPath = QFileDialog::getOpenFileName(Q_NULLPTR, "Pick a Path", QDir::homePath(), tr("SVG (*.svg)"));
+    if (!svgPath.isEmpty()) {
+        ui->frame->importSvgPath(svgPath);
+    }
+}
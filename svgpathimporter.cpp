@@ -0,0 +1,481 @@
+#include "svgpathimporter.h"
+
+#include <QFile>
+#include <QLineF>
+#include <QRegularExpression>
+#include <QStringView>
+#include <QVector>
+#include <QtMath>
+
+#include <cmath>
+
+namespace  {
+// Maximum distance in pixels between a curve and its flattened polyline, held
+// for every frame up to the largest size the W/H spin boxes allow.
+const qreal kFlattenTolerance = 0.25;
+const qreal kMaxFrameExtent = 2048;
+const int kMaxSubdivision = 16;
+
+// Path data reduced to moves, lines and cubics, so the bounds are known
+// before anything is flattened.
+struct Segment {
+    enum Type {
+        Move,
+        Line,
+        Cubic
+    };
+    Type    type;
+    QPointF c1;
+    QPointF c2;
+    QPointF end;
+};
+
+qreal distanceToChord(const QPointF& p, const QPointF& a, const QPointF& b)
+{
+    QPointF ab = b - a;
+    qreal length = std::hypot(ab.x(), ab.y());
+    if (qFuzzyIsNull(length)) {
+        return QLineF(p, a).length();
+    }
+    return std::abs(ab.x() * (a.y() - p.y()) - ab.y() * (a.x() - p.x())) / length;
+}
+
+qreal vectorAngle(qreal ux, qreal uy, qreal vx, qreal vy)
+{
+    return std::atan2(ux * vy - uy * vx, ux * vx + uy * vy);
+}
+
+// Parser for the SVG path mini language, see
+// https://www.w3.org/TR/SVG11/paths.html#PathDataBNF
+class PathDataParser
+{
+public:
+    PathDataParser(const QString& data, QVector<Segment>* segments)
+        :_data(data)
+        ,_segments(segments)
+    {
+    }
+
+    bool parse()
+    {
+        QChar command;
+        while (skipSeparators()) {
+            QChar c = _data[_pos];
+            if (isCommand(c)) {
+                command = c;
+                _pos++;
+            } else if (command.isNull() || command == 'z' || command == 'Z') {
+                return false;
+            } else if (command == 'M') {
+                // Coordinate pairs following a moveto are implicit linetos
+                command = 'L';
+            } else if (command == 'm') {
+                command = 'l';
+            }
+            if (!parseCommand(command)) {
+                return false;
+            }
+            _lastCommand = command.toUpper();
+        }
+        return true;
+    }
+
+private:
+    bool parseCommand(QChar command)
+    {
+        bool relative = command.isLower();
+        QPointF origin = relative ? _current : QPointF();
+        switch (command.toUpper().unicode()) {
+        case 'M': {
+            QPointF p;
+            if (!readPoint(&p)) {
+                return false;
+            }
+            _current = _subpathStart = origin + p;
+            _segments->push_back({Segment::Move, QPointF(), QPointF(), _current});
+            return true;
+        }
+        case 'L': {
+            QPointF p;
+            if (!readPoint(&p)) {
+                return false;
+            }
+            lineTo(origin + p);
+            return true;
+        }
+        case 'H': {
+            qreal x;
+            if (!readNumber(&x)) {
+                return false;
+            }
+            lineTo(QPointF(origin.x() + x, _current.y()));
+            return true;
+        }
+        case 'V': {
+            qreal y;
+            if (!readNumber(&y)) {
+                return false;
+            }
+            lineTo(QPointF(_current.x(), origin.y() + y));
+            return true;
+        }
+        case 'C': {
+            QPointF c1, c2, end;
+            if (!readPoint(&c1) || !readPoint(&c2) || !readPoint(&end)) {
+                return false;
+            }
+            cubicTo(origin + c1, origin + c2, origin + end);
+            return true;
+        }
+        case 'S': {
+            QPointF c2, end;
+            if (!readPoint(&c2) || !readPoint(&end)) {
+                return false;
+            }
+            QPointF c1 = (_lastCommand == 'C' || _lastCommand == 'S') ? 2 * _current - _lastControl : _current;
+            cubicTo(c1, origin + c2, origin + end);
+            return true;
+        }
+        case 'Q': {
+            QPointF c, end;
+            if (!readPoint(&c) || !readPoint(&end)) {
+                return false;
+            }
+            quadTo(origin + c, origin + end);
+            return true;
+        }
+        case 'T': {
+            QPointF end;
+            if (!readPoint(&end)) {
+                return false;
+            }
+            QPointF c = (_lastCommand == 'Q' || _lastCommand == 'T') ? 2 * _current - _lastControl : _current;
+            quadTo(c, origin + end);
+            return true;
+        }
+        case 'A': {
+            qreal rx, ry, angle;
+            bool largeArc, sweep;
+            QPointF end;
+            if (!readNumber(&rx) || !readNumber(&ry) || !readNumber(&angle) ||
+                !readFlag(&largeArc) || !readFlag(&sweep) || !readPoint(&end)) {
+                return false;
+            }
+            arcTo(rx, ry, angle, largeArc, sweep, origin + end);
+            return true;
+        }
+        case 'Z':
+            lineTo(_subpathStart);
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    bool isCommand(QChar c) const
+    {
+        switch (c.toUpper().unicode()) {
+        case 'M': case 'L': case 'H': case 'V': case 'C':
+        case 'S': case 'Q': case 'T': case 'A': case 'Z':
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    bool skipSeparators()
+    {
+        while (_pos < _data.size() && (_data[_pos].isSpace() || _data[_pos] == ',')) {
+            _pos++;
+        }
+        return _pos < _data.size();
+    }
+
+    bool readNumber(qreal* value)
+    {
+        if (!skipSeparators()) {
+            return false;
+        }
+        int start = _pos;
+        auto digits = [this]() {
+            int begin = _pos;
+            while (_pos < _data.size() && _data[_pos].isDigit()) {
+                _pos++;
+            }
+            return _pos > begin;
+        };
+        if (_data[_pos] == '+' || _data[_pos] == '-') {
+            _pos++;
+        }
+        bool mantissa = digits();
+        if (_pos < _data.size() && _data[_pos] == '.') {
+            _pos++;
+            mantissa = digits() || mantissa;
+        }
+        if (!mantissa) {
+            return false;
+        }
+        if (_pos < _data.size() && (_data[_pos] == 'e' || _data[_pos] == 'E')) {
+            int exponent = _pos++;
+            if (_pos < _data.size() && (_data[_pos] == '+' || _data[_pos] == '-')) {
+                _pos++;
+            }
+            if (!digits()) {
+                _pos = exponent;
+            }
+        }
+        bool ok = false;
+        *value = QStringView(_data).mid(start, _pos - start).toDouble(&ok);
+        return ok;
+    }
+
+    bool readFlag(bool* flag)
+    {
+        // Flags are single characters and may be written without separators
+        if (!skipSeparators() || (_data[_pos] != '0' && _data[_pos] != '1')) {
+            return false;
+        }
+        *flag = _data[_pos++] == '1';
+        return true;
+    }
+
+    bool readPoint(QPointF* p)
+    {
+        qreal x, y;
+        if (!readNumber(&x) || !readNumber(&y)) {
+            return false;
+        }
+        *p = QPointF(x, y);
+        return true;
+    }
+
+    void lineTo(const QPointF& p)
+    {
+        _segments->push_back({Segment::Line, QPointF(), QPointF(), p});
+        _current = p;
+    }
+
+    void cubicTo(const QPointF& c1, const QPointF& c2, const QPointF& end)
+    {
+        _segments->push_back({Segment::Cubic, c1, c2, end});
+        _lastControl = c2;
+        _current = end;
+    }
+
+    void quadTo(const QPointF& c, const QPointF& end)
+    {
+        // Degree elevation, a quadratic is an exact cubic
+        _segments->push_back({Segment::Cubic, _current + 2.0 / 3.0 * (c - _current), end + 2.0 / 3.0 * (c - end), end});
+        _lastControl = c;
+        _current = end;
+    }
+
+    // Endpoint to center conversion from the SVG implementation notes, then
+    // every quarter turn of the arc is approximated by a cubic.
+    void arcTo(qreal rx, qreal ry, qreal angle, bool largeArc, bool sweep, const QPointF& end)
+    {
+        if (_current == end) {
+            return;
+        }
+        rx = std::abs(rx);
+        ry = std::abs(ry);
+        if (qFuzzyIsNull(rx) || qFuzzyIsNull(ry)) {
+            lineTo(end);
+            return;
+        }
+        qreal phi = qDegreesToRadians(angle);
+        qreal cosPhi = std::cos(phi);
+        qreal sinPhi = std::sin(phi);
+        qreal dx2 = (_current.x() - end.x()) / 2;
+        qreal dy2 = (_current.y() - end.y()) / 2;
+        qreal x1 = cosPhi * dx2 + sinPhi * dy2;
+        qreal y1 = -sinPhi * dx2 + cosPhi * dy2;
+        qreal lambda = (x1 * x1) / (rx * rx) + (y1 * y1) / (ry * ry);
+        if (lambda > 1) {
+            rx *= std::sqrt(lambda);
+            ry *= std::sqrt(lambda);
+        }
+        qreal num = rx * rx * ry * ry - rx * rx * y1 * y1 - ry * ry * x1 * x1;
+        qreal den = rx * rx * y1 * y1 + ry * ry * x1 * x1;
+        qreal coef = std::sqrt(qMax<qreal>(0, num / den)) * (largeArc == sweep ? -1 : 1);
+        qreal cx1 = coef * rx * y1 / ry;
+        qreal cy1 = -coef * ry * x1 / rx;
+        qreal cx = cosPhi * cx1 - sinPhi * cy1 + (_current.x() + end.x()) / 2;
+        qreal cy = sinPhi * cx1 + cosPhi * cy1 + (_current.y() + end.y()) / 2;
+        qreal theta = vectorAngle(1, 0, (x1 - cx1) / rx, (y1 - cy1) / ry);
+        qreal delta = vectorAngle((x1 - cx1) / rx, (y1 - cy1) / ry, (-x1 - cx1) / rx, (-y1 - cy1) / ry);
+        if (!sweep && delta > 0) {
+            delta -= 2 * M_PI;
+        } else if (sweep && delta < 0) {
+            delta += 2 * M_PI;
+        }
+        int segments = qMax(1, int(std::ceil(std::abs(delta) / (M_PI / 2) - 1e-6)));
+        qreal step = delta / segments;
+        qreal handle = 4.0 / 3.0 * std::tan(step / 4);
+        auto map = [&](qreal x, qreal y) {
+            return QPointF(cx + cosPhi * rx * x - sinPhi * ry * y,
+                           cy + sinPhi * rx * x + cosPhi * ry * y);
+        };
+        for (int i = 0; i < segments; i++) {
+            qreal a1 = theta + i * step;
+            qreal a2 = a1 + step;
+            QPointF c1 = map(std::cos(a1) - handle * std::sin(a1), std::sin(a1) + handle * std::cos(a1));
+            QPointF c2 = map(std::cos(a2) + handle * std::sin(a2), std::sin(a2) - handle * std::cos(a2));
+            QPointF p = i == segments - 1 ? end : map(std::cos(a2), std::sin(a2));
+            _segments->push_back({Segment::Cubic, c1, c2, p});
+            _current = p;
+        }
+        _current = end;
+    }
+
+private:
+    const QString&      _data;
+    QVector<Segment>*   _segments;
+    int                 _pos = 0;
+    QChar               _lastCommand;
+    QPointF             _current;
+    QPointF             _subpathStart;
+    QPointF             _lastControl;
+};
+
+void flattenCubic(const QPointF& p0, const QPointF& p1, const QPointF& p2, const QPointF& p3,
+                  qreal tolerance, int depth, AnimationFrame::SegmentTable* table)
+{
+    // The curve lies inside the hull of its control points, so it is flat
+    // enough once both inner control points are within tolerance of the chord.
+    if (depth >= kMaxSubdivision ||
+        (distanceToChord(p1, p0, p3) <= tolerance && distanceToChord(p2, p0, p3) <= tolerance)) {
+        table->lineTo(p3);
+        return;
+    }
+    QPointF p01 = (p0 + p1) / 2;
+    QPointF p12 = (p1 + p2) / 2;
+    QPointF p23 = (p2 + p3) / 2;
+    QPointF p012 = (p01 + p12) / 2;
+    QPointF p123 = (p12 + p23) / 2;
+    QPointF mid = (p012 + p123) / 2;
+    flattenCubic(p0, p01, p012, mid, tolerance, depth + 1, table);
+    flattenCubic(mid, p123, p23, p3, tolerance, depth + 1, table);
+}
+
+// Bounds of all end and control points, the hull contains every curve.
+QRectF controlBounds(const QVector<Segment>& segments)
+{
+    qreal left = qInf(), top = qInf(), right = -qInf(), bottom = -qInf();
+    auto unite = [&](const QPointF& p) {
+        left = qMin(left, p.x());
+        top = qMin(top, p.y());
+        right = qMax(right, p.x());
+        bottom = qMax(bottom, p.y());
+    };
+    for (const auto& segment : segments) {
+        if (segment.type == Segment::Cubic) {
+            unite(segment.c1);
+            unite(segment.c2);
+        }
+        unite(segment.end);
+    }
+    if (segments.isEmpty()) {
+        return QRectF();
+    }
+    return QRectF(QPointF(left, top), QPointF(right, bottom));
+}
+
+QRectF readViewBox(const QXmlStreamAttributes& attributes)
+{
+    auto viewBox = attributes.value("viewBox").toString().split(QRegularExpression("[\\s,]+"), Qt::SkipEmptyParts);
+    if (viewBox.size() == 4) {
+        return QRectF(viewBox[0].toDouble(), viewBox[1].toDouble(), viewBox[2].toDouble(), viewBox[3].toDouble());
+    }
+    // Without a viewBox the user space is width x height, ignoring units
+    auto length = [](QStringView value) {
+        int end = 0;
+        while (end < value.size() && (value[end].isDigit() || value[end] == '.')) {
+            end++;
+        }
+        return value.left(end).toDouble();
+    };
+    qreal w = length(attributes.value("width"));
+    qreal h = length(attributes.value("height"));
+    if (w > 0 && h > 0) {
+        return QRectF(0, 0, w, h);
+    }
+    return QRectF();
+}
+}
+
+SvgPathImporter::SvgPathImporter(QObject *parent)
+    :QObject(parent)
+{
+    qRegisterMetaType<AnimationFrame::SegmentTable>();
+}
+
+void SvgPathImporter::import(const QString &filePath, int generation)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        emit failed(QString("Cannot open %1").arg(filePath), generation);
+        return;
+    }
+    // The reader pulls from the file as it goes, it never loads it whole
+    QXmlStreamReader reader(&file);
+    QRectF viewBox;
+    while (!reader.atEnd()) {
+        if (reader.readNext() != QXmlStreamReader::StartElement) {
+            continue;
+        }
+        if (reader.name() == QLatin1String("svg")) {
+            viewBox = readViewBox(reader.attributes());
+        } else if (reader.name() == QLatin1String("path")) {
+            QString data = reader.attributes().value("d").toString();
+            if (!data.isEmpty()) {
+                parsePathData(data, viewBox, filePath, generation);
+                return;
+            }
+        }
+    }
+    if (reader.hasError()) {
+        emit failed(reader.errorString(), generation);
+    } else {
+        emit failed(QString("%1 has no <path> with path data").arg(filePath), generation);
+    }
+}
+
+void SvgPathImporter::parsePathData(const QString &data, const QRectF &viewBox, const QString &filePath, int generation)
+{
+    QVector<Segment> segments;
+    PathDataParser parser(data, &segments);
+    // Like an SVG renderer, keep everything parsed before the first error
+    parser.parse();
+    QRectF bounds = viewBox.isValid() ? viewBox : controlBounds(segments);
+    qreal extent = qMax(bounds.width(), bounds.height());
+    if (segments.size() < 2 || qFuzzyIsNull(extent)) {
+        emit failed(QString("Malformed path data in %1").arg(filePath), generation);
+        return;
+    }
+    // Flatten in user units for the largest frame the path can be fitted into
+    qreal tolerance = kFlattenTolerance * extent / kMaxFrameExtent;
+    AnimationFrame::SegmentTable table;
+    for (const auto& segment : segments) {
+        switch (segment.type) {
+        case Segment::Move:
+            table.moveTo(segment.end);
+            break;
+        case Segment::Line:
+            table.lineTo(segment.end);
+            break;
+        case Segment::Cubic:
+            flattenCubic(table.points.isEmpty() ? QPointF() : table.points.last(),
+                         segment.c1, segment.c2, segment.end, tolerance, 0, &table);
+            break;
+        }
+    }
+    if (table.isEmpty()) {
+        emit failed(QString("Malformed path data in %1").arg(filePath), generation);
+        return;
+    }
+    // Fit the same rectangle the tolerance was derived from, the curve's own
+    // bounds can be smaller and would enlarge it past the tolerance.
+    table.viewBox = bounds;
+    emit finished(table, generation);
+}
@@ -0,0 +1,29 @@
+#ifndef SVGPATHIMPORTER_H
+#define SVGPATHIMPORTER_H
+
+#include <QObject>
+#include <QRectF>
+#include <QString>
+#include <QXmlStreamReader>
+
+#include "animationframe.h"
+
+Q_DECLARE_METATYPE(AnimationFrame::SegmentTable)
+
+// Reads the first <path d=...> of an SVG file and flattens it into a
+// SegmentTable. Lives on a worker thread, so neither the XML streaming nor
+// parsing and flattening a path with thousands of segments touches the UI.
+class SvgPathImporter : public QObject
+{
+    Q_OBJECT
+public:
+    SvgPathImporter(QObject* parent = nullptr);
+    void import(const QString& filePath, int generation);
+signals:
+    void finished(const AnimationFrame::SegmentTable& table, int generation);
+    void failed(const QString& message, int generation);
+private:
+    void parsePathData(const QString& data, const QRectF& viewBox, const QString& filePath, int generation);
+};
+
+#endif // SVGPATHIMPORTER_H
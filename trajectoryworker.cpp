@@ -0,0 +1,78 @@
+#include "trajectoryworker.h"
+
+#include <cmath>
+
+namespace  {
+const int kSamplesPerSecond = 120;
+// Ten minutes at full rate, longer animations are sampled more coarsely
+const int kMaxSamples = kSamplesPerSecond * 600;
+
+bool hasPath(const TrajectoryRequest& request)
+{
+    switch (request.pathType) {
+    case AnimationFrame::Line:
+        return request.points.size() > 1;
+    case AnimationFrame::Bezier:
+        return request.points.size() > 3;
+    case AnimationFrame::Svg:
+        return !request.svg.isEmpty();
+    }
+    return false;
+}
+
+QPoint pathPoint(const TrajectoryRequest& request, qreal t)
+{
+    const QVector<QPoint>& p = request.points;
+    switch (request.pathType) {
+    case AnimationFrame::Line:
+        return p[0] + (p[1] - p[0]) * t;
+    case AnimationFrame::Bezier:
+        return p[0] * pow(1 - t, 3) +
+                3 * p[1] * t * pow(1 - t, 2) +
+                3 * p[2] * pow(t, 2) * (1 - t) +
+                p[3] * pow(t, 3);
+    case AnimationFrame::Svg:
+        return request.svgTransform.map(request.svg.pointAtPercent(t)).toPoint();
+    }
+    return QPoint();
+}
+}
+
+QPoint TrajectoryBuffer::positionAt(int object, qreal progress) const
+{
+    if (frameCount == 0) {
+        return QPoint();
+    }
+    int index = qBound(0, qRound(progress * (frameCount - 1)), frameCount - 1);
+    return positions[object][index];
+}
+
+TrajectoryWorker::TrajectoryWorker(QObject *parent)
+    :QObject(parent)
+{
+    qRegisterMetaType<TrajectoryBufferPtr>();
+}
+
+void TrajectoryWorker::compute(const TrajectoryRequest &request)
+{
+    auto buffer = QSharedPointer<TrajectoryBuffer>::create();
+    if (hasPath(request)) {
+        qreal samples = std::ceil(request.duration * kSamplesPerSecond) + 1;
+        buffer->frameCount = int(qBound<qreal>(2, samples, kMaxSamples));
+    }
+    for (int i = 0; i < AnimationFrame::kObjectCount; i++) {
+        // Objects whose inputs did not change keep sharing the previous samples
+        if (!(request.dirtyObjects & (1 << i)) && _last && _last->frameCount == buffer->frameCount) {
+            buffer->positions[i] = _last->positions[i];
+            continue;
+        }
+        QEasingCurve easing(request.easingTypes[i]);
+        QVector<QPoint>& positions = buffer->positions[i];
+        positions.resize(buffer->frameCount);
+        for (int frame = 0; frame < buffer->frameCount; frame++) {
+            positions[frame] = pathPoint(request, easing.valueForProgress(frame / qreal(buffer->frameCount - 1)));
+        }
+    }
+    _last = buffer;
+    emit computed(buffer);
+}
@@ -0,0 +1,49 @@
+#ifndef TRAJECTORYWORKER_H
+#define TRAJECTORYWORKER_H
+
+#include <QEasingCurve>
+#include <QObject>
+#include <QPoint>
+#include <QSharedPointer>
+#include <QTransform>
+#include <QVector>
+
+#include "animationframe.h"
+
+// Snapshot of everything the motion depends on, taken on the GUI thread so
+// the worker never touches the frame. dirtyObjects is a bit mask of the
+// objects whose trajectory has to be recomputed.
+struct TrajectoryRequest {
+    AnimationFrame::PathType        pathType = AnimationFrame::Line;
+    QVector<QPoint>                 points;
+    AnimationFrame::SegmentTable    svg;
+    QTransform                      svgTransform;
+    QEasingCurve::Type              easingTypes[AnimationFrame::kObjectCount];
+    double                          duration = 1.0;
+    int                             dirtyObjects = 0;
+};
+
+// Positions of every object sampled over the whole animation, read only once
+// it has been handed to the GUI thread.
+struct TrajectoryBuffer {
+    int                 frameCount = 0;
+    QVector<QPoint>     positions[AnimationFrame::kObjectCount];
+    QPoint positionAt(int object, qreal progress) const;
+};
+
+typedef QSharedPointer<const TrajectoryBuffer> TrajectoryBufferPtr;
+Q_DECLARE_METATYPE(TrajectoryBufferPtr)
+
+class TrajectoryWorker : public QObject
+{
+    Q_OBJECT
+public:
+    TrajectoryWorker(QObject* parent = nullptr);
+    void compute(const TrajectoryRequest& request);
+signals:
+    void computed(TrajectoryBufferPtr buffer);
+private:
+    TrajectoryBufferPtr _last;
+};
+
+#endif // TRAJECTORYWORKER_H